@@ -22,7 +22,7 @@
 //  SOFTWARE.
 //  
 
-#include "c++-wrapper/sf.h"
+#include "c++-wrapper/fanout.h"
 
 #include <algorithm>
 #include <cmath>
@@ -30,7 +30,10 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <iostream> // TODO: Remove!
 
@@ -68,6 +71,177 @@ namespace
             return result;
         }
 
+        // One rendering of the input. Any number of these may be rendered
+        // from a single decode of the input file.
+        struct variant
+        {
+            std::string path;
+            double acceleration = 0.0;
+            std::vector<normal_range> normal_ranges;
+        };
+
+        // Variants are separated on the command line by "--", e.g.
+        // <outfile> <accel> <normal-range>... -- <outfile> <accel> <normal-range>...
+        static std::vector<variant>
+        get_variants(char* const* begin, char* const* end, double sample_rate)
+        {
+            std::vector<variant> result;
+
+            while (begin != end)
+            {
+                auto next = std::find_if(begin, end, [](const char* arg) { return std::strcmp(arg, "--") == 0; });
+                if (next - begin < 3)
+                {
+                    usage();
+                }
+
+                variant v;
+                v.path = begin[0];
+                v.acceleration = std::stod(begin[1]);
+                v.normal_ranges = get_normal_ranges(begin + 2, next, sample_rate);
+                result.push_back(std::move(v));
+
+                begin = (next == end) ? end : next + 1;
+            }
+
+            return result;
+        }
+
+        // Plays normal ranges at normal speed, and between them accelerates
+        // to a peak halfway and decelerates again.
+        class renderer final : public sf::renderer
+        {
+        public:
+            renderer(const variant& v, const sf::file::info& info, bool qc)
+                : v_(v),
+                  samplerate_(info.samplerate),
+                  channels_(info.channels),
+                  out_(v.path, info, qc),
+                  next_peak_(v.normal_ranges[0].start / 2)
+            {
+                std::cerr << "Initial speed is " << speed_ << std::endl;
+                std::cout << "Normal start: " << v_.normal_ranges[next_range_].start << std::endl;
+                std::cout << "Normal stop: " << v_.normal_ranges[next_range_].stop << std::endl;
+            }
+
+            const sf::output&
+            out() const
+            {
+                return out_;
+            }
+
+            bool
+            render(const sf::window& input) override
+            {
+                const double acceleration = v_.acceleration;
+                const auto& normal_ranges = v_.normal_ranges;
+
+                while (src_t_ >= 0.0 && (input.frames() < 0 || src_t_ < input.frames()))
+                {
+                    auto frame = static_cast<sf::count_t>(src_t_);
+                    if (frame >= input.end())
+                    {
+                        out_.flush(dest_t_);
+                        return true;
+                    }
+                    if (frame < input.begin())
+                    {
+                        throw std::runtime_error(v_.path + ": Speed fell below zero, and the input can't be read backwards");
+                    }
+
+                    // After the last normal range, the peak is halfway to the
+                    // end of the input, so wait until that's known.
+                    if (input.frames() < 0 &&
+                        src_t_ > normal_ranges[next_range_].stop &&
+                        next_range_ + 1 >= normal_ranges.size())
+                    {
+                        out_.flush(dest_t_);
+                        return true;
+                    }
+
+                    for (int chan = 0; chan < channels_; ++chan)
+                    {
+                        out_.set(dest_t_, chan, input.get(frame, chan));
+                    }
+
+                    // Speed changes once per frame, so that every channel of a
+                    // frame comes from the same source frame.
+                    if (src_t_ >= normal_ranges[next_range_].start &&
+                        src_t_ <= normal_ranges[next_range_].stop)
+                    {
+                        speed_ = normal_speed;
+                    }
+                    else
+                    {
+                        if (src_t_ > normal_ranges[next_range_].stop)
+                        {
+                            if (next_range_ + 1 < normal_ranges.size())
+                            {
+                                double first = normal_ranges[next_range_].stop;
+                                ++next_range_;
+                                double last = normal_ranges[next_range_].start;
+                                next_peak_ = (last - first) / 2 + first;
+                            }
+                            else
+                            {
+                                double first = normal_ranges[next_range_].stop;
+                                double last = input.frames();
+                                next_peak_ = (last - first) / 2 + first;
+                            }
+                        }
+                        if (src_t_ > next_peak_)
+                        {
+                            // Decelerate
+                            speed_ -= acceleration;
+                        }
+                        else
+                        {
+                            // Accelerate
+                            speed_ += acceleration;
+                        }
+                    }
+
+                    src_t_ += speed_;
+                    dest_t_ += 1;
+
+                    if (dest_t_ % samplerate_ == 0)
+                    {
+                        std::cout << v_.path << ": source time: " << src_t_ << ", destination time: " << dest_t_ << ", speed: " << speed_ << std::endl;
+                        std::cout << "    Normal start: " << normal_ranges[next_range_].start << std::endl;
+                        std::cout << "    Normal stop: " << normal_ranges[next_range_].stop << std::endl;
+
+                    }
+                }
+
+                out_.finish();
+                return false;
+            }
+
+            sf::count_t
+            position() const override
+            {
+                return static_cast<sf::count_t>(std::max(src_t_, 0.0));
+            }
+
+        private:
+            static constexpr double normal_speed = 1.0;
+
+            variant v_;
+            int samplerate_;
+            int channels_;
+            sf::output out_;
+
+            // Find velocity at start of song. We do this by ramping backward
+            // to the beginning of the song from the start of the normal speed
+            // range. (Since we're doing this backwards, we call the final velocity
+            // function.)
+            double speed_ = normal_speed;
+            double src_t_ = 0;
+            sf::count_t dest_t_ = 0;
+            size_t next_range_ = 0;
+            double next_peak_;
+        };
+
         static std::string&
         program_name()
         {
@@ -78,7 +252,7 @@ namespace
         static void
         usage()
         {
-            std::cerr << "Usage: " << program_name() << " <infile> <outfile> <accel> <normal-range> [<normal-range>...]" << std::endl;
+            std::cerr << "Usage: " << program_name() << " [--qc] <infile> <outfile> <accel> <normal-range> [<normal-range>...] [-- <outfile> <accel> <normal-range> [<normal-range>...]...]" << std::endl;
             exit(EXIT_FAILURE);
         }
 
@@ -89,6 +263,13 @@ int main(int argc, char** argv)
     try
     {
         impl::program_name() = argv[0];
+        bool qc = argc > 1 && std::strcmp(argv[1], "--qc") == 0;
+        if (qc)
+        {
+            ++argv;
+            --argc;
+        }
+
         if (argc < 5)
         {
             impl::usage();
@@ -96,108 +277,25 @@ int main(int argc, char** argv)
 
         sf::file::info info;
         sf::file in(argv[1], SFM_READ, info);
-        sf::file out(argv[2], SFM_WRITE, info);
 
-        double acceleration = std::stod(argv[3]);
-        auto normal_ranges = impl::get_normal_ranges(argv + 4, argv + argc, info.samplerate);
+        auto variants = impl::get_variants(argv + 2, argv + argc, info.samplerate);
 
-        std::vector<double> input(info.frames * info.channels);
-        if (input.size() == 0)
+        // Open every output up front so that a bad path fails before decoding.
+        std::vector<std::unique_ptr<impl::renderer>> renderers;
+        std::vector<sf::renderer*> fan;
+        for (const auto& v : variants)
         {
-            input.resize(100 * 1000 * 1000);
+            renderers.push_back(std::make_unique<impl::renderer>(v, info, qc));
+            fan.push_back(renderers.back().get());
         }
 
-        std::vector<double> output;
-        output.reserve(input.size());
-
-        in.read(input);
-
-        std::cout << "input.size() is " << input.size() << std::endl;
-
-        constexpr double normal_speed = 1.0;
-        
-        // Find velocity at start of song. We do this by ramping backward
-        // to the beginning of the song from the start of the normal speed
-        // range. (Since we're doing this backwards, we call the final velocity
-        // function.)
-        double speed = normal_speed;
-        std::cerr << "Initial speed is " << speed << std::endl;
-        double src_t = 0;
-        int dest_t = 0;
-        int next_range = 0;
-        double next_peak = normal_ranges[0].start / 2;
-
-        std::cout << "Normal start: " << normal_ranges[next_range].start << std::endl;
-        std::cout << "Normal stop: " << normal_ranges[next_range].stop << std::endl;
-        while (src_t >= 0.0 && src_t < input.size() / info.channels)
-        {
-            for (int chan = 0; chan < info.channels; ++chan)
-            {
-                int in_index = static_cast<int>(src_t) * info.channels + chan;
-                int out_index = dest_t * info.channels + chan;
-
-                if (output.size() <= out_index)
-                {
-                    output.resize(out_index + 1);
-                }
-                output[out_index] = input[in_index];
-
-                if (src_t >= normal_ranges[next_range].start &&
-                    src_t <= normal_ranges[next_range].stop)
-                {
-                    speed = normal_speed;
-                }
-                else
-                {
-                    if (src_t > normal_ranges[next_range].stop)
-                    {
-                        if (next_range + 1 < normal_ranges.size())
-                        {
-                            double first = normal_ranges[next_range].stop;
-                            ++next_range;
-                            double last = normal_ranges[next_range].start;
-                            next_peak = (last - first) / 2 + first;
-                        }
-                        else
-                        {
-                            double first = normal_ranges[next_range].stop;
-                            double last = input.size() / info.channels;
-                            next_peak = (last - first) / 2 + first;
-                        }
-                    }
-                    if (src_t > next_peak)
-                    {
-                        // Decelerate
-                        speed -= acceleration;
-                    }
-                    else
-                    {
-                        // Accelerate
-                        speed += acceleration;
-                    }
-                }
-                
-                src_t += speed;
-                dest_t += 1;
-
-                if (dest_t % info.samplerate == 0)
-                {
-                    std::cout << "source time: " << src_t << ", destination time: " << dest_t << ", speed: " << speed << std::endl;
-                    std::cout << "    Normal start: " << normal_ranges[next_range].start << std::endl;
-                    std::cout << "    Normal stop: " << normal_ranges[next_range].stop << std::endl;
-
-                }
-            }
-        }
+        sf::count_t frames = sf::fan_out(in, info, fan);
 
-        for (size_t begin = 0; begin < output.size();)
+        std::cout << "input.size() is " << frames * info.channels << std::endl;
+        for (const auto& r : renderers)
         {
-            size_t end = std::min(begin + 1024 * 1024, output.size());
-            std::vector buffer(output.begin() + begin, output.begin() + end);
-            out.write(buffer);
-            begin = end;
+            std::cerr << "output size of " << r->out().path() << " is " << r->out().frames() * info.channels << std::endl;
         }
-        std::cerr << "output size is " << output.size() << std::endl;
     }
     catch (std::exception& e)
     {
@@ -0,0 +1,321 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+#include "sf.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace sf
+{
+    struct analysis::Implementation
+    {
+        // Direct form II transposed biquad
+        struct biquad
+        {
+            double b0 = 1.0, b1 = 0.0, b2 = 0.0;
+            double a1 = 0.0, a2 = 0.0;
+            double z1 = 0.0, z2 = 0.0;
+
+            double
+            operator()(double x)
+            {
+                double y = b0 * x + z1;
+                z1 = b1 * x - a1 * y + z2;
+                z2 = b2 * x - a2 * y;
+                return y;
+            }
+        };
+
+        // K-weighting pre-filter and RLB high-pass of ITU-R BS.1770,
+        // designed for an arbitrary sample rate.
+        struct k_filter
+        {
+            explicit k_filter(int samplerate)
+            {
+                double f0 = 1681.974450955533;
+                double g  = 3.999843853973347;
+                double q  = 0.7071752369554196;
+                double k  = std::tan(M_PI * f0 / samplerate);
+                double vh = std::pow(10.0, g / 20.0);
+                double vb = std::pow(vh, 0.4996667741545416);
+                double a0 = 1.0 + k / q + k * k;
+
+                shelf.b0 = (vh + vb * k / q + k * k) / a0;
+                shelf.b1 = 2.0 * (k * k - vh) / a0;
+                shelf.b2 = (vh - vb * k / q + k * k) / a0;
+                shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+                shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+                f0 = 38.13547087602444;
+                q  = 0.5003270373238773;
+                k  = std::tan(M_PI * f0 / samplerate);
+                a0 = 1.0 + k / q + k * k;
+
+                highpass.b0 = 1.0;
+                highpass.b1 = -2.0;
+                highpass.b2 = 1.0;
+                highpass.a1 = 2.0 * (k * k - 1.0) / a0;
+                highpass.a2 = (1.0 - k / q + k * k) / a0;
+            }
+
+            double
+            operator()(double x)
+            {
+                return highpass(shelf(x));
+            }
+
+            biquad shelf;
+            biquad highpass;
+        };
+
+        Implementation(int samplerate, int channels)
+            : channels(channels),
+              step_frames(std::max(samplerate / 10, 1))
+        {
+            if (samplerate <= 0 || channels <= 0)
+            {
+                throw std::runtime_error("Analysis needs a sample rate and channel count.");
+            }
+            filters.assign(channels, k_filter(samplerate));
+        }
+
+        // Values at or beyond full scale for each sample type, after
+        // scaling to [-1.0, 1.0].
+        template<typename NumberType>
+        static constexpr double
+        full_scale()
+        {
+            if constexpr (std::is_integral_v<NumberType>)
+            {
+                return -static_cast<double>(std::numeric_limits<NumberType>::min());
+            }
+            else
+            {
+                return 1.0;
+            }
+        }
+
+        template<typename NumberType>
+        void
+        add(const NumberType* data, count_t count)
+        {
+            constexpr double scale = 1.0 / full_scale<NumberType>();
+            constexpr double clip_level = std::is_integral_v<NumberType>
+                ? std::numeric_limits<NumberType>::max() * scale
+                : 1.0;
+
+            // Peak, RMS and clips don't depend on the sample order, so let
+            // the compiler reorder these reductions and vectorize the loop
+            // (needs -fopenmp-simd).
+            double max = 0.0;
+            double sum = 0.0;
+            count_t over = 0;
+            #pragma omp simd reduction(max:max) reduction(+:sum, over)
+            for (count_t i = 0; i < count; ++i)
+            {
+                double v = std::abs(data[i] * scale);
+                max = std::max(max, v);
+                sum += v * v;
+                over += (v >= clip_level);
+            }
+            sample_peak = std::max(sample_peak, max);
+            sum_squares += sum;
+            samples += count;
+            clip_count += over;
+
+            // Loudness
+            for (count_t i = 0; i < count; ++i)
+            {
+                double v = filters[channel](data[i] * scale);
+                step_energy += v * v;
+                if (++channel == channels)
+                {
+                    channel = 0;
+                    if (++step_count == step_frames)
+                    {
+                        end_step();
+                    }
+                }
+            }
+        }
+
+        // Gating blocks are 400ms long and overlap by 75%, so one is
+        // completed at the end of every 100ms step after the third.
+        void
+        end_step()
+        {
+            steps[step_index++ % steps.size()] = step_energy;
+            if (step_index >= steps.size())
+            {
+                double energy = 0.0;
+                for (double e : steps)
+                {
+                    energy += e;
+                }
+                blocks.push_back(energy / (steps.size() * step_frames));
+            }
+            step_energy = 0.0;
+            step_count = 0;
+        }
+
+        static double
+        to_db(double v)
+        {
+            return v > 0.0 ? 20.0 * std::log10(v) : -std::numeric_limits<double>::infinity();
+        }
+
+        static double
+        to_lufs(double energy)
+        {
+            return energy > 0.0 ? -0.691 + 10.0 * std::log10(energy) : -std::numeric_limits<double>::infinity();
+        }
+
+        double
+        loudness() const
+        {
+            constexpr double absolute_gate = -70.0;
+            constexpr double relative_gate = -10.0;
+
+            double sum = 0.0;
+            size_t count = 0;
+            for (double e : blocks)
+            {
+                if (to_lufs(e) > absolute_gate)
+                {
+                    sum += e;
+                    ++count;
+                }
+            }
+            if (count == 0)
+            {
+                return -std::numeric_limits<double>::infinity();
+            }
+
+            double threshold = to_lufs(sum / count) + relative_gate;
+            sum = 0.0;
+            count = 0;
+            for (double e : blocks)
+            {
+                double l = to_lufs(e);
+                if (l > absolute_gate && l > threshold)
+                {
+                    sum += e;
+                    ++count;
+                }
+            }
+            return count == 0 ? -std::numeric_limits<double>::infinity() : to_lufs(sum / count);
+        }
+
+        int channels;
+        count_t step_frames;
+
+        double sample_peak = 0.0;
+        double sum_squares = 0.0;
+        count_t samples = 0;
+        count_t clip_count = 0;
+
+        std::vector<k_filter> filters;
+        int channel = 0;
+        count_t step_count = 0;
+        double step_energy = 0.0;
+        std::array<double, 4> steps{};
+        size_t step_index = 0;
+        std::vector<double> blocks;
+    };
+
+    analysis::analysis(int samplerate, int channels)
+        : impl_(std::make_unique<Implementation>(samplerate, channels))
+    {
+    }
+
+    analysis::~analysis() = default;
+
+    void
+    analysis::add(const short* data, count_t count)
+    {
+        impl_->add(data, count);
+    }
+
+    void
+    analysis::add(const int* data, count_t count)
+    {
+        impl_->add(data, count);
+    }
+
+    void
+    analysis::add(const float* data, count_t count)
+    {
+        impl_->add(data, count);
+    }
+
+    void
+    analysis::add(const double* data, count_t count)
+    {
+        impl_->add(data, count);
+    }
+
+    count_t
+    analysis::clips() const
+    {
+        return impl_->clip_count;
+    }
+
+    double
+    analysis::loudness() const
+    {
+        return impl_->loudness();
+    }
+
+    double
+    analysis::peak() const
+    {
+        return Implementation::to_db(impl_->sample_peak);
+    }
+
+    double
+    analysis::rms() const
+    {
+        return impl_->samples == 0
+            ? -std::numeric_limits<double>::infinity()
+            : Implementation::to_db(std::sqrt(impl_->sum_squares / impl_->samples));
+    }
+
+    std::string
+    analysis::to_string() const
+    {
+        std::ostringstream out;
+        out << "peak_dbfs=" << peak() << "\n"
+            << "rms_dbfs=" << rms() << "\n"
+            << "loudness_lufs=" << loudness() << "\n"
+            << "clips=" << clips() << "\n";
+        return out.str();
+    }
+}
@@ -0,0 +1,193 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+#include "fanout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sf
+{
+    window::window(int channels, count_t frames)
+        : channels_(channels),
+          frames_(frames)
+    {
+    }
+
+    void
+    window::append(const std::vector<double>& block, bool last)
+    {
+        samples_.insert(samples_.end(), block.begin(), block.end());
+        end_ += block.size() / channels_;
+        if (last)
+        {
+            frames_ = end_;
+        }
+    }
+
+    void
+    window::release(count_t frame)
+    {
+        begin_ = std::max(begin_, std::min(frame, end_));
+
+        // Move the frames still needed to the front only once the dropped
+        // ones are the larger part, so that each frame moves at most once
+        // on average.
+        size_t dropped = (begin_ - base_) * channels_;
+        if (dropped * 2 > samples_.size())
+        {
+            samples_.erase(samples_.begin(), samples_.begin() + dropped);
+            base_ = begin_;
+        }
+    }
+
+    output::output(const std::string& path, const file::info& info, bool qc)
+        : path_(path),
+          info_(info),
+          file_(path, SFM_WRITE, info_),
+          qc_(qc),
+          channels_(info.channels)
+    {
+        if (qc_)
+        {
+            file_.analyze();
+        }
+    }
+
+    void
+    output::flush(count_t frame)
+    {
+        frame = std::min(frame, base_ + static_cast<count_t>(pending_.size() / channels_));
+
+        // libsndfile only takes whole frames.
+        const count_t block_frames = 1024 * 1024 / channels_;
+        while (written_ < frame)
+        {
+            count_t end = std::min(written_ + block_frames, frame);
+            auto first = pending_.begin() + (written_ - base_) * channels_;
+            std::vector<double> buffer(first, first + (end - written_) * channels_);
+            file_.write(buffer);
+            written_ = end;
+        }
+
+        // As in window::release()
+        size_t dropped = (written_ - base_) * channels_;
+        if (dropped * 2 > pending_.size())
+        {
+            pending_.erase(pending_.begin(), pending_.begin() + dropped);
+            base_ = written_;
+        }
+    }
+
+    void
+    output::finish()
+    {
+        flush(base_ + pending_.size() / channels_);
+        if (qc_)
+        {
+            std::ofstream qc(path_ + ".qc");
+            qc << file_.get_analysis().to_string();
+            if (!qc)
+            {
+                throw std::runtime_error(path_ + ".qc: Unable to write QC results");
+            }
+        }
+    }
+
+    count_t
+    fan_out(file& in, const file::info& info, const std::vector<renderer*>& renderers)
+    {
+        // Small enough that a block is still in cache when the last renderer
+        // reads it.
+        constexpr count_t block_frames = 16 * 1024;
+
+        // libsndfile can't know the length of a pipe (it reports one as
+        // unseekable, with a meaningless frame count) and a few files report
+        // no frames, so those are read until they run out.
+        window input(info.channels, (info.seekable && info.frames > 0) ? info.frames : -1);
+
+        const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<renderer*> running(renderers);
+        std::vector<double> block;
+        while (!running.empty())
+        {
+            bool complete = input.end() == input.frames();
+            if (!complete)
+            {
+                block.resize(block_frames * info.channels);
+                in.read(block);
+                input.append(block, block.size() < static_cast<size_t>(block_frames * info.channels));
+            }
+
+            std::vector<char> more(running.size());
+            std::atomic<size_t> next{0};
+            auto render_next = [&]
+            {
+                for (size_t i = next++; i < running.size(); i = next++)
+                {
+                    more[i] = running[i]->render(input);
+                }
+            };
+
+            std::vector<std::future<void>> workers;
+            for (size_t i = 1; i < std::min(running.size(), cores); ++i)
+            {
+                workers.push_back(std::async(std::launch::async, render_next));
+            }
+            render_next();
+            for (auto& worker : workers)
+            {
+                worker.get();
+            }
+
+            // Drop the finished renderers, and the frames that none of the
+            // others will read again.
+            count_t keep = input.end();
+            size_t kept = 0;
+            for (size_t i = 0; i < running.size(); ++i)
+            {
+                if (more[i])
+                {
+                    running[kept++] = running[i];
+                    keep = std::min(keep, running[i]->position());
+                }
+            }
+            running.resize(kept);
+            input.release(keep);
+
+            if (complete && !running.empty())
+            {
+                throw std::logic_error("A renderer didn't finish at the end of the input");
+            }
+        }
+
+        return input.end();
+    }
+}
@@ -0,0 +1,168 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+#ifndef SF_FANOUT_H
+#define SF_FANOUT_H
+
+#include "sf.h"
+
+#include <string>
+#include <vector>
+
+// Rendering any number of variants of one input from a single decode of
+// it. The input is decoded a block at a time, and every renderer reads
+// each block before the next one is decoded, so only the frames that some
+// renderer may still read are held in memory.
+namespace sf
+{
+    // The decoded input frames [begin(), end()).
+    class window final
+    {
+    public:
+        // <frames> is the length of the whole input, or -1 if it isn't known
+        // until the input runs out.
+        window(int channels, count_t frames);
+
+        count_t
+        begin() const
+        {
+            return begin_;
+        }
+
+        count_t
+        end() const
+        {
+            return end_;
+        }
+
+        // Length of the whole input, or -1 while that isn't known yet.
+        count_t
+        frames() const
+        {
+            return frames_;
+        }
+
+        // Sample <chan> of <frame>, which must be in [begin(), end()).
+        double
+        get(count_t frame, int chan) const
+        {
+            return samples_[(frame - base_) * channels_ + chan];
+        }
+
+        // Add <block> after end(). <last> marks the end of the input.
+        void
+        append(const std::vector<double>& block, bool last);
+
+        // Drop the frames before <frame>.
+        void
+        release(count_t frame);
+
+    private:
+        std::vector<double> samples_;
+        int channels_;
+        count_t base_ = 0;   // frame of samples_[0]
+        count_t begin_ = 0;
+        count_t end_ = 0;
+        count_t frames_;
+    };
+
+    // One output file. Samples may be set in any order, but only in frames
+    // after the last flush(). Frames not yet flushed are held in memory.
+    // Frames are whole when they're written, and any channel left unset is
+    // silent.
+    class output final
+    {
+    public:
+        // With <qc>, the output is analyzed as it's written and finish()
+        // writes the results to <path>.qc.
+        output(const std::string& path, const file::info& info, bool qc);
+
+        const std::string&
+        path() const
+        {
+            return path_;
+        }
+
+        // Frames written so far
+        count_t
+        frames() const
+        {
+            return written_;
+        }
+
+        void
+        set(count_t frame, int chan, double value)
+        {
+            size_t index = (frame - base_) * channels_ + chan;
+            if (pending_.size() <= index)
+            {
+                pending_.resize(index - chan + channels_);
+            }
+            pending_[index] = value;
+        }
+
+        // Write every frame before <frame>.
+        void
+        flush(count_t frame);
+
+        // Write all remaining frames, then the QC results if asked for.
+        void
+        finish();
+
+    private:
+        std::string path_;
+        file::info info_;
+        file file_;
+        bool qc_;
+        int channels_;
+        std::vector<double> pending_;
+        count_t base_ = 0;   // frame of pending_[0]
+        count_t written_ = 0;
+    };
+
+    // One rendering of the input.
+    class renderer
+    {
+    public:
+        virtual ~renderer() = default;
+
+        // Render as far as <input> allows. Returns false once the rendering
+        // is complete, which it must be once input.end() == input.frames().
+        virtual bool
+        render(const window& input) = 0;
+
+        // First input frame this rendering may still read. This must never
+        // decrease.
+        virtual count_t
+        position() const = 0;
+    };
+
+    // Decode <in> once and render every one of <renderers> from it. The
+    // renderers run concurrently, at most one per core. Returns the number
+    // of input frames.
+    count_t
+    fan_out(file& in, const file::info& info, const std::vector<renderer*>& renderers);
+}
+
+#endif
@@ -79,11 +79,10 @@ namespace sf
         {
             if (!buffer.empty())
             {
+                // Shrink the buffer to what was read, which is nothing at the
+                // end of the file.
                 sf_count_t result = wrap(callable, buffer.data(), buffer.size());
-                if (result != 0)
-                {
-                    buffer.resize(result);
-                }
+                buffer.resize(result);
             }
         }
 
@@ -91,11 +90,24 @@ namespace sf
         void
         wrap_write(Callable callable, const std::vector<NumberType>& buffer)
         {
-            wrap(callable, buffer.data(), buffer.size());
+            sf_count_t result = wrap(callable, buffer.data(), buffer.size());
+            if (result != static_cast<sf_count_t>(buffer.size()))
+            {
+                // libsndfile reports some failures, such as a buffer that
+                // isn't a whole number of frames, only as a short count,
+                // so there's no error string to add.
+                throw std::runtime_error("Short write: wrote " + std::to_string(result) +
+                                         " of " + std::to_string(buffer.size()) + " samples");
+            }
+            if (analysis)
+            {
+                analysis->add(buffer.data(), result);
+            }
         }
 
         SNDFILE* sndfile = nullptr;
         sf::file::info info;
+        std::unique_ptr<sf::analysis> analysis;
     };
 
     file::file(const std::string& path, int mode, info& info)
@@ -114,12 +126,28 @@ namespace sf
         }
     }
 
+    void
+    file::analyze()
+    {
+        impl_->analysis = std::make_unique<sf::analysis>(impl_->info.samplerate, impl_->info.channels);
+    }
+
     void
     file::command(int cmd, void *data, int datasize)
     {
         impl_->wrap(sf_command, cmd, data, datasize);
     }
 
+    const sf::analysis&
+    file::get_analysis() const
+    {
+        if (!impl_->analysis)
+        {
+            throw std::runtime_error("Analysis is not enabled.");
+        }
+        return *impl_->analysis;
+    }
+
     std::string
     file::get_string(int str_type)
     {
@@ -138,6 +166,7 @@ namespace sf
         {
             impl_->throw_error(path);
         }
+        impl_->info = info;
     }
 
     void
@@ -22,6 +22,9 @@
 //  SOFTWARE.
 //  
 
+#ifndef SF_H
+#define SF_H
+
 #include <sndfile.h>
 
 #include <memory>
@@ -31,7 +34,55 @@
 namespace sf
 {
     using count_t = sf_count_t;
-    
+
+    // Accumulates peak, RMS, clip count and gated (EBU R128 style) integrated
+    // loudness over interleaved samples as they are written, so that QC does
+    // not need a second pass over the output.
+    class analysis final
+    {
+    public:
+        analysis(int samplerate, int channels);
+
+        ~analysis();
+
+        void
+        add(const short* data, count_t count);
+
+        void
+        add(const int* data, count_t count);
+
+        void
+        add(const float* data, count_t count);
+
+        void
+        add(const double* data, count_t count);
+
+        count_t
+        clips() const;
+
+        // Integrated loudness in LUFS, or -infinity if everything was gated.
+        double
+        loudness() const;
+
+        // Sample peak in dBFS.
+        double
+        peak() const;
+
+        // RMS in dBFS.
+        double
+        rms() const;
+
+        // One "key=value" line per result, suitable for a sidecar file or
+        // for file::set_string(). Values are plain numbers; the key names
+        // the unit, as in "peak_dbfs=-6.02".
+        std::string
+        to_string() const;
+
+    private:
+        struct Implementation;
+        std::unique_ptr<Implementation> impl_;
+    };
+
     class file final
     {
     public:
@@ -41,9 +92,16 @@ namespace sf
 
         ~file();
 
+        // Start accumulating an analysis of everything written from now on.
+        void
+        analyze();
+
         void
         command(int cmd, void *data, int datasize);
 
+        const sf::analysis&
+        get_analysis() const;
+
         std::string
         get_string(int str_type);
         
@@ -88,3 +146,5 @@ namespace sf
         std::unique_ptr<Implementation> impl_;
     };
 }
+
+#endif
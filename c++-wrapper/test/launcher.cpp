@@ -0,0 +1,77 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+// Runs a command and writes its wall time in seconds and its peak resident
+// memory in KiB to a file, for the stress tests. The tests can't measure a
+// tool they start themselves: a process started by posix_spawn() or fork()
+// inherits its parent's peak RSS, which for the test binary includes all
+// of its signals. This launcher is small, so the peak that the command
+// inherits from it is too.
+
+#include <cstdio>
+#include <ctime>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s <result-file> <command> [<arg>...]\n", argv[0]);
+        return 127;
+    }
+
+    timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        execv(argv[2], argv + 2);
+        _exit(127);
+    }
+
+    int status;
+    rusage usage;
+    if (pid < 0 || wait4(pid, &status, 0, &usage) != pid)
+    {
+        return 127;
+    }
+
+    timespec stop;
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    double seconds = (stop.tv_sec - start.tv_sec) + (stop.tv_nsec - start.tv_nsec) / 1e9;
+
+    std::FILE* result = std::fopen(argv[1], "w");
+    if (result == nullptr ||
+        std::fprintf(result, "%.6f %ld\n", seconds, usage.ru_maxrss) < 0 ||
+        std::fclose(result) != 0)
+    {
+        return 127;
+    }
+
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
@@ -0,0 +1,790 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+#include <gtest/gtest.h>
+
+#include "../sf.h"
+#include "synth.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+// Long-signal tests. These are slow, so ctest only runs them when the
+// build is configured with -DSF_STRESS_TESTS=ON. Set SF_STRESS_SECONDS to
+// change the length of the signals, e.g. to several hours for multi-GB
+// inputs. The benchmarks always use signals of bench_frames, so that their
+// results don't depend on it. They compare throughput (relative to an
+// in-process run of comparable work, so that it doesn't depend on the
+// machine or build type) and peak memory with stress-baselines.txt, or
+// with the file named by SF_STRESS_BASELINES.
+namespace
+{
+    constexpr int samplerate = 48000;
+
+    std::string
+    get_sf_path(const std::string& fname)
+    {
+        return std::string(SF_TEST_SOUND_DIR) + "/" + fname;
+    }
+
+    std::string
+    get_tmp_path(const std::string& fname)
+    {
+        return std::string("/tmp/") + fname;
+    }
+
+    std::string
+    get_tool_path(const std::string& fname)
+    {
+        return std::string(SF_TOOL_DIR) + "/" + fname;
+    }
+
+    // Fixed costs, such as starting a process, weigh the same in every
+    // benchmark run and baseline only if the length is fixed too.
+    constexpr sf::count_t bench_frames = 60 * samplerate;
+
+    // Benchmarks take the best of this many runs, which is far steadier
+    // than any single run.
+    constexpr int bench_runs = 5;
+
+    sf::count_t
+    stress_frames()
+    {
+        const char* seconds = std::getenv("SF_STRESS_SECONDS");
+        return static_cast<sf::count_t>((seconds ? std::stod(seconds) : 60.0) * samplerate);
+    }
+
+    double
+    seconds_since(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    double
+    baseline(const std::string& name)
+    {
+        static std::map<std::string, double> baselines = []
+        {
+            const char* path = std::getenv("SF_STRESS_BASELINES");
+            std::ifstream in(path ? path : get_sf_path("stress-baselines.txt"));
+            std::map<std::string, double> result;
+            std::string line;
+            while (std::getline(in, line))
+            {
+                std::string key;
+                double value;
+                if (line.empty() || line[0] == '#')
+                {
+                    continue;
+                }
+                std::istringstream fields(line);
+                if (fields >> key >> value)
+                {
+                    result[key] = value;
+                }
+            }
+            return result;
+        }();
+
+        auto iter = baselines.find(name);
+        if (iter == baselines.end())
+        {
+            ADD_FAILURE() << "No baseline for " << name;
+            return 0.0;
+        }
+        return iter->second;
+    }
+
+    // <seconds> is how long the code under test took, <calibration> how
+    // long comparable in-process work took on the same machine and build.
+    // Their ratio must not fall too far below the baseline.
+    void
+    check_throughput(const std::string& name, double calibration, double seconds)
+    {
+        double relative = calibration / seconds;
+        double minimum = baseline(name + ".throughput") * (1.0 - baseline("throughput_tolerance"));
+        testing::Test::RecordProperty(name + ".throughput", std::to_string(relative));
+        EXPECT_GE(relative, minimum) << name << " throughput regressed";
+    }
+
+    // Peak resident memory, in MiB, must not rise too far above the
+    // baseline.
+    void
+    check_memory(const std::string& name, double peak_bytes)
+    {
+        double mib = peak_bytes / (1024.0 * 1024.0);
+        double maximum = baseline(name + ".memory") * (1.0 + baseline("memory_tolerance"));
+        testing::Test::RecordProperty(name + ".memory", std::to_string(mib));
+        EXPECT_LE(mib, maximum) << name << " peak memory regressed";
+    }
+
+    // Write all of <data> to <fd>, giving up if the reader goes away.
+    void
+    write_all(int fd, const std::string& data)
+    {
+        std::signal(SIGPIPE, SIG_IGN);
+        for (size_t done = 0; done < data.size();)
+        {
+            ssize_t written = write(fd, data.data() + done, data.size() - done);
+            if (written <= 0)
+            {
+                break;
+            }
+            done += written;
+        }
+    }
+
+    struct run_result
+    {
+        int status = -1;
+        double seconds = 0.0;
+        double peak_bytes = 0.0;
+    };
+
+    // Run one of the tools with its output discarded, measuring its wall
+    // time and peak resident memory through the launcher (see
+    // launcher.cpp). If <input> isn't empty, it's fed to the tool's
+    // standard input through a pipe.
+    run_result
+    run_tool(const std::vector<std::string>& args, const std::string& input = "")
+    {
+        const std::string measurements = get_tmp_path("stress-launcher.txt");
+        std::vector<std::string> command = {SF_LAUNCHER, measurements};
+        command.insert(command.end(), args.begin(), args.end());
+
+        std::vector<char*> argv;
+        for (const auto& arg : command)
+        {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        run_result result;
+        int fds[2] = {-1, -1};
+        if (!input.empty() && pipe(fds) != 0)
+        {
+            return result;
+        }
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+        if (!input.empty())
+        {
+            posix_spawn_file_actions_adddup2(&actions, fds[0], STDIN_FILENO);
+            posix_spawn_file_actions_addclose(&actions, fds[0]);
+            posix_spawn_file_actions_addclose(&actions, fds[1]);
+        }
+
+        pid_t pid;
+        int error = posix_spawn(&pid, argv[0], &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        if (!input.empty())
+        {
+            close(fds[0]);
+            if (error == 0)
+            {
+                write_all(fds[1], input);
+            }
+            close(fds[1]);
+        }
+        if (error != 0)
+        {
+            return result;
+        }
+
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+        {
+            return result;
+        }
+        result.status = WEXITSTATUS(status);
+
+        double peak_kib = 0.0;
+        std::ifstream in(measurements);
+        if (!(in >> result.seconds >> peak_kib))
+        {
+            ADD_FAILURE() << "No measurements from " << args[0];
+        }
+        result.peak_bytes = peak_kib * 1024.0;
+        return result;
+    }
+
+    // Run a tool bench_runs times, alternating with in-process calibration
+    // work, so that anything else slowing the machine down slows both alike.
+    // Gives the tool's fastest run, with the highest peak memory of any of
+    // them, and the fastest calibration.
+    template<typename Callable>
+    std::pair<run_result, double>
+    benchmark(const std::vector<std::string>& args, Callable calibrate)
+    {
+        run_result best;
+        double calibration = std::numeric_limits<double>::infinity();
+        for (int i = 0; i < bench_runs; ++i)
+        {
+            run_result result = run_tool(args);
+            if (result.status != 0)
+            {
+                return {result, calibration};
+            }
+            best.seconds = (i == 0) ? result.seconds : std::min(best.seconds, result.seconds);
+            best.peak_bytes = std::max(best.peak_bytes, result.peak_bytes);
+            best.status = 0;
+
+            auto start = std::chrono::steady_clock::now();
+            calibrate();
+            calibration = std::min(calibration, seconds_since(start));
+        }
+        return {best, calibration};
+    }
+
+    std::string
+    read_bytes(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::vector<float>
+    read_all(const std::string& path, sf::file::info& info)
+    {
+        sf::file in(path, SFM_READ, info);
+        std::vector<float> result(info.frames * info.channels);
+        in.read(result);
+        return result;
+    }
+
+    // speed-cycle as intended: each channel is resampled by itself, at a
+    // speed that swings sinusoidally between minspeed and maxspeed over
+    // twenty seconds of output, with odd channels in antiphase. Channels
+    // that run out early are padded with silence.
+    std::vector<float>
+    speed_cycle_reference(const std::vector<float>& input, int channels, double minspeed, double maxspeed)
+    {
+        const double middle = (maxspeed + minspeed) / 2.0;
+        const double swing = (maxspeed - minspeed) / 2.0;
+        const size_t frames = input.size() / channels;
+
+        std::vector<std::vector<float>> rendered(channels);
+        size_t out_frames = 0;
+        for (int chan = 0; chan < channels; ++chan)
+        {
+            double offset = 0;
+            for (size_t count = 0; offset >= 0.0 && offset < frames; ++count)
+            {
+                rendered[chan].push_back(input[static_cast<size_t>(offset) * channels + chan]);
+                double speed = swing * sin(static_cast<double>(count) * M_PI / (samplerate * 10) + chan * M_PI) + middle;
+                offset += speed;
+            }
+            out_frames = std::max(out_frames, rendered[chan].size());
+        }
+
+        std::vector<float> output(out_frames * channels);
+        for (int chan = 0; chan < channels; ++chan)
+        {
+            for (size_t i = 0; i < rendered[chan].size(); ++i)
+            {
+                output[i * channels + chan] = rendered[chan][i];
+            }
+        }
+        return output;
+    }
+
+    // accel-decel as intended: inside a normal range (given in whole
+    // seconds) frames play at exactly normal speed. Elsewhere speed rises
+    // by <acceleration> per frame up to the midpoint between ranges (or
+    // between a range and either end) and falls by as much after it. All
+    // channels of a frame come from the same source frame.
+    std::vector<float>
+    accel_decel_reference(const std::vector<float>& input, int channels, double acceleration,
+                          const std::vector<std::pair<int, int>>& ranges)
+    {
+        const size_t frames = input.size() / channels;
+        std::vector<float> output;
+        double speed = 1.0;
+        double src = 0.0;
+        size_t range = 0;
+        double peak = ranges[0].first * samplerate / 2.0;
+        while (src >= 0.0 && src < frames)
+        {
+            auto frame = input.begin() + static_cast<size_t>(src) * channels;
+            output.insert(output.end(), frame, frame + channels);
+
+            double start = ranges[range].first * static_cast<double>(samplerate);
+            double stop = ranges[range].second * static_cast<double>(samplerate);
+            if (src >= start && src <= stop)
+            {
+                speed = 1.0;
+            }
+            else
+            {
+                if (src > stop)
+                {
+                    double next = frames;
+                    if (range + 1 < ranges.size())
+                    {
+                        ++range;
+                        next = ranges[range].first * static_cast<double>(samplerate);
+                    }
+                    peak = (next - stop) / 2 + stop;
+                }
+                speed += (src > peak) ? -acceleration : acceleration;
+            }
+            src += speed;
+        }
+        return output;
+    }
+
+    // Write <signal> to <path> with libsndfile and read it back, in blocks
+    // that aren't a power of two.
+    std::vector<float>
+    round_trip(const std::string& path, const std::vector<float>& signal, int channels)
+    {
+        synth::write(path, signal, samplerate, channels);
+
+        sf::file::info info;
+        sf::file in(path, SFM_READ, info);
+        EXPECT_EQ(info.frames, static_cast<sf::count_t>(signal.size() / channels));
+        EXPECT_EQ(info.channels, channels);
+
+        std::vector<float> result;
+        result.reserve(signal.size());
+        while (result.size() < signal.size())
+        {
+            std::vector<float> block(std::min<size_t>(12345 * channels, signal.size() - result.size()));
+            in.read(block);
+            if (block.empty())
+            {
+                ADD_FAILURE() << path << " ended after " << result.size() / channels << " frames";
+                break;
+            }
+            result.insert(result.end(), block.begin(), block.end());
+        }
+        return result;
+    }
+
+    // Arguments for an accel-decel run over <frames> with a normal-speed
+    // range every ten seconds, which are added to <ranges>
+    std::vector<std::string>
+    accel_decel_args(const std::string& in, const std::string& out, sf::count_t frames,
+                     std::vector<std::pair<int, int>>& ranges)
+    {
+        std::vector<std::string> args = {get_tool_path("accel-decel"), in, out, "0.000001"};
+        for (int second = 2; second + 3 < frames / samplerate; second += 10)
+        {
+            ranges.emplace_back(second, second + 3);
+            args.push_back(std::to_string(second) + "," + std::to_string(second + 3));
+        }
+        return args;
+    }
+
+    // Check that, while every channel of a speed-cycle rendering of a ramp
+    // is still running, consecutive samples are never further apart in the
+    // source than minspeed and maxspeed allow.
+    void
+    check_speed_limits(const std::vector<float>& output, int channels, sf::count_t frames,
+                       double minspeed, double maxspeed)
+    {
+        const auto slowest = static_cast<sf::count_t>(std::floor(minspeed));
+        const auto fastest = static_cast<sf::count_t>(std::ceil(maxspeed));
+        const auto checked = static_cast<size_t>(frames / (2 * maxspeed));
+        ASSERT_LE((checked + 1) * channels, output.size());
+
+        size_t violations = 0;
+        for (int chan = 0; chan < channels; ++chan)
+        {
+            for (size_t i = 0; i < checked; ++i)
+            {
+                auto step = synth::ramp_step(output[i * channels + chan], output[(i + 1) * channels + chan]);
+                violations += (step < slowest || step > fastest);
+            }
+        }
+        EXPECT_EQ(violations, 0u) << "speed left [" << minspeed << ", " << maxspeed << "]";
+    }
+
+    // Check that an accel-decel rendering of a ramp takes every channel of
+    // a frame from the same source frame, and plays each normal range at
+    // exactly one output frame per input frame.
+    void
+    check_normal_ranges(const std::vector<float>& output, int channels,
+                        const std::vector<std::pair<int, int>>& ranges)
+    {
+        const size_t out_frames = output.size() / channels;
+        std::vector<sf::count_t> source(out_frames);
+        size_t mixed = 0;
+        for (size_t i = 0; i < out_frames; ++i)
+        {
+            auto frame = output.begin() + i * channels;
+            mixed += !std::all_of(frame, frame + channels, [&](float v) { return v == *frame; });
+            if (i > 0)
+            {
+                source[i] = source[i - 1] + synth::ramp_step(output[(i - 1) * channels], *frame);
+            }
+        }
+        EXPECT_EQ(mixed, 0u) << "frames mix channels from different source frames";
+
+        for (const auto& range : ranges)
+        {
+            sf::count_t start = static_cast<sf::count_t>(range.first) * samplerate;
+            sf::count_t stop = static_cast<sf::count_t>(range.second) * samplerate;
+            auto played = std::count_if(source.begin(), source.end(),
+                                        [&](sf::count_t s) { return s > start && s <= stop; });
+            EXPECT_EQ(played, stop - start) << "normal range " << range.first << "," << range.second;
+        }
+    }
+}
+
+TEST(StressTest, SynthTest)
+{
+    auto a = synth::noise(1000, 3, 42);
+    auto b = synth::noise(1000, 3, 42);
+    auto c = synth::noise(1000, 3, 43);
+    EXPECT_EQ(a.size(), 3000u);
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+
+    auto tone = synth::tone(samplerate, samplerate, 2, 1000.0, 0.25);
+    EXPECT_EQ(tone.size(), 2u * samplerate);
+    EXPECT_NEAR(*std::max_element(tone.begin(), tone.end()), 0.25, 1e-6);
+    EXPECT_NE(tone[2], tone[3]);
+
+    auto chirp = synth::chirp(samplerate, samplerate, 5, 20.0, 20000.0);
+    EXPECT_EQ(chirp.size(), 5u * samplerate);
+    EXPECT_FLOAT_EQ(chirp[0], 0.0f);
+    EXPECT_NE(chirp[1], 0.0f);
+
+    auto ramp = synth::ramp((1 << 24) + 2, 2);
+    EXPECT_EQ(ramp[0], ramp[1]);
+    EXPECT_EQ(synth::ramp_step(ramp[0], ramp[2]), 1);
+    EXPECT_EQ(synth::ramp_step(ramp[2], ramp[8]), 3);
+    EXPECT_EQ(synth::ramp_step(ramp[2 * ((1 << 24) - 1)], ramp[2 * (1 << 24)]), 1);
+}
+
+TEST(StressTest, RoundTripTest)
+{
+    // Odd channel count
+    constexpr int channels = 7;
+    auto signal = synth::chirp(stress_frames(), samplerate, channels, 20.0, 20000.0);
+    EXPECT_EQ(round_trip(get_tmp_path("stress-roundtrip.wav"), signal, channels), signal);
+
+    // Partial frames can't be written.
+    sf::file::info winfo{};
+    winfo.samplerate = samplerate;
+    winfo.channels = 3;
+    winfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    sf::file out(get_tmp_path("stress-partial.wav"), SFM_WRITE, winfo);
+    EXPECT_THROW(out.write(std::vector<float>(10)), std::runtime_error);
+}
+
+TEST(StressTest, UnknownLengthTest)
+{
+    // libsndfile can't know the length of a stream read from a pipe. It
+    // reports the stream as unseekable, with a frame count that has nothing
+    // to do with its length, so the tools have to read it until it ends.
+    // An AU header with the "unknown size" marker, as written by a live
+    // encoder, makes sure the header doesn't give the length away either.
+    constexpr int channels = 3;
+    const sf::count_t frames = 10 * samplerate;
+    auto signal = synth::ramp(frames, channels);
+    synth::write(get_tmp_path("stress-unknown.au"), signal, samplerate, channels, SF_FORMAT_AU | SF_FORMAT_FLOAT);
+    auto stream = read_bytes(get_tmp_path("stress-unknown.au"));
+    ASSERT_GT(stream.size(), 12u);
+    stream.replace(8, 4, "\xff\xff\xff\xff");
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    std::thread writer([&]
+    {
+        write_all(fds[1], stream);
+        close(fds[1]);
+    });
+
+    sf::file::info info{};
+    std::vector<float> result;
+    try
+    {
+        sf::file in("/dev/fd/" + std::to_string(fds[0]), SFM_READ, info);
+        close(fds[0]);
+        fds[0] = -1;
+        std::vector<float> block;
+        do
+        {
+            block.resize(4096 * channels);
+            in.read(block);
+            result.insert(result.end(), block.begin(), block.end());
+        }
+        while (!block.empty());
+    }
+    catch (...)
+    {
+        if (fds[0] >= 0)
+        {
+            close(fds[0]);
+        }
+        writer.join();
+        throw;
+    }
+    writer.join();
+
+    EXPECT_EQ(info.seekable, 0);
+    EXPECT_NE(info.frames, frames);
+    EXPECT_EQ(result, signal);
+
+    if (access(get_tool_path("speed-cycle").c_str(), X_OK) != 0 ||
+        access(get_tool_path("accel-decel").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "speed-cycle and accel-decel have not been built";
+    }
+
+    sf::file::info rinfo;
+    ASSERT_EQ(run_tool({get_tool_path("speed-cycle"), "-", get_tmp_path("stress-unknown-speed.wav")}, stream).status, 0);
+    EXPECT_EQ(read_all(get_tmp_path("stress-unknown-speed.wav"), rinfo), speed_cycle_reference(signal, channels, 1.0, 3.0));
+
+    ASSERT_EQ(run_tool({get_tool_path("accel-decel"), "-", get_tmp_path("stress-unknown-accel.wav"), "0.000001", "2,5"}, stream).status, 0);
+    EXPECT_EQ(read_all(get_tmp_path("stress-unknown-accel.wav"), rinfo), accel_decel_reference(signal, channels, 0.000001, {{2, 5}}));
+}
+
+TEST(StressTest, AnalysisTest)
+{
+    constexpr int channels = 3;
+    const sf::count_t frames = stress_frames();
+    auto signal = synth::noise(frames, channels, 1234, 1.25);
+
+    sf::analysis analysis(samplerate, channels);
+    const size_t block = 4096 * channels;
+    for (size_t begin = 0; begin < signal.size(); begin += block)
+    {
+        analysis.add(signal.data() + begin, std::min(block, signal.size() - begin));
+    }
+
+    double peak = 0.0;
+    double sum = 0.0;
+    sf::count_t clips = 0;
+    for (float sample : signal)
+    {
+        peak = std::max(peak, std::abs(static_cast<double>(sample)));
+        sum += static_cast<double>(sample) * sample;
+        clips += std::abs(sample) >= 1.0f;
+    }
+
+    EXPECT_NEAR(analysis.peak(), 20.0 * std::log10(peak), 1e-9);
+    EXPECT_NEAR(analysis.rms(), 10.0 * std::log10(sum / signal.size()), 1e-6);
+    EXPECT_EQ(analysis.clips(), clips);
+    EXPECT_TRUE(std::isfinite(analysis.loudness()));
+}
+
+TEST(StressTest, SpeedCycleTest)
+{
+    if (access(get_tool_path("speed-cycle").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "speed-cycle has not been built";
+    }
+
+    constexpr int channels = 3;
+    const sf::count_t frames = stress_frames();
+    auto signal = synth::ramp(frames, channels);
+    synth::write(get_tmp_path("stress-speed-in.wav"), signal, samplerate, channels);
+
+    ASSERT_EQ(run_tool({get_tool_path("speed-cycle"),
+                        get_tmp_path("stress-speed-in.wav"),
+                        get_tmp_path("stress-speed-a.wav"),
+                        get_tmp_path("stress-speed-b.wav") + ":1,2"}).status, 0);
+
+    sf::file::info info;
+    auto output_a = read_all(get_tmp_path("stress-speed-a.wav"), info);
+    auto output_b = read_all(get_tmp_path("stress-speed-b.wav"), info);
+    EXPECT_EQ(output_a, speed_cycle_reference(signal, channels, 1.0, 3.0));
+    EXPECT_EQ(output_b, speed_cycle_reference(signal, channels, 1.0, 2.0));
+    check_speed_limits(output_a, channels, frames, 1.0, 3.0);
+    check_speed_limits(output_b, channels, frames, 1.0, 2.0);
+}
+
+TEST(StressTest, AccelDecelTest)
+{
+    if (access(get_tool_path("accel-decel").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "accel-decel has not been built";
+    }
+
+    constexpr int channels = 5;
+    constexpr double acceleration = 0.000001;
+    const sf::count_t frames = stress_frames();
+    auto signal = synth::ramp(frames, channels);
+    synth::write(get_tmp_path("stress-accel-in.wav"), signal, samplerate, channels);
+
+    // A long speed curve: a normal-speed range every ten seconds
+    std::vector<std::pair<int, int>> ranges;
+    auto args = accel_decel_args(get_tmp_path("stress-accel-in.wav"), get_tmp_path("stress-accel-out.wav"), frames, ranges);
+    ASSERT_FALSE(ranges.empty()) << "SF_STRESS_SECONDS is too short";
+    ASSERT_EQ(run_tool(args).status, 0);
+
+    sf::file::info info;
+    auto output = read_all(get_tmp_path("stress-accel-out.wav"), info);
+    EXPECT_EQ(output, accel_decel_reference(signal, channels, acceleration, ranges));
+    check_normal_ranges(output, channels, ranges);
+}
+
+TEST(StressTest, SpeedCycleBenchmark)
+{
+    if (access(get_tool_path("speed-cycle").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "speed-cycle has not been built";
+    }
+
+    constexpr int channels = 3;
+    auto signal = synth::ramp(bench_frames, channels);
+    synth::write(get_tmp_path("stress-speed-bench.wav"), signal, samplerate, channels);
+
+    std::vector<float> reference_a;
+    std::vector<float> reference_b;
+    auto [result, calibration] = benchmark({get_tool_path("speed-cycle"),
+                                            get_tmp_path("stress-speed-bench.wav"),
+                                            get_tmp_path("stress-speed-a.wav"),
+                                            get_tmp_path("stress-speed-b.wav") + ":1,2"},
+                                           [&]
+                                           {
+                                               reference_a = speed_cycle_reference(signal, channels, 1.0, 3.0);
+                                               reference_b = speed_cycle_reference(signal, channels, 1.0, 2.0);
+                                           });
+    ASSERT_EQ(result.status, 0);
+
+    // The tool renders its variants in parallel, the references in series.
+    calibration /= std::min(2u, std::max(1u, std::thread::hardware_concurrency()));
+
+    check_throughput("speed-cycle", calibration, result.seconds);
+    check_memory("speed-cycle", result.peak_bytes);
+}
+
+TEST(StressTest, AccelDecelBenchmark)
+{
+    if (access(get_tool_path("accel-decel").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "accel-decel has not been built";
+    }
+
+    constexpr int channels = 5;
+    auto signal = synth::ramp(bench_frames, channels);
+    synth::write(get_tmp_path("stress-accel-bench.wav"), signal, samplerate, channels);
+
+    std::vector<std::pair<int, int>> ranges;
+    auto args = accel_decel_args(get_tmp_path("stress-accel-bench.wav"), get_tmp_path("stress-accel-out.wav"),
+                                 bench_frames, ranges);
+    std::vector<float> reference;
+    auto [result, calibration] = benchmark(args, [&]
+    {
+        reference = accel_decel_reference(signal, channels, 0.000001, ranges);
+    });
+    ASSERT_EQ(result.status, 0);
+
+    check_throughput("accel-decel", calibration, result.seconds);
+    check_memory("accel-decel", result.peak_bytes);
+}
+
+// Quick checks of how speed-cycle reads its variants. These aren't stress
+// tests, so they run with the rest of wrapper-test.
+TEST(ToolTest, SpeedCycleVariantTest)
+{
+    if (access(get_tool_path("speed-cycle").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "speed-cycle has not been built";
+    }
+
+    constexpr int channels = 2;
+    auto signal = synth::ramp(samplerate, channels);
+    synth::write(get_tmp_path("tool-variant-in.wav"), signal, samplerate, channels);
+    const std::string tool = get_tool_path("speed-cycle");
+    const std::string in = get_tmp_path("tool-variant-in.wav");
+
+    // A suffix that isn't two speeds is part of the path.
+    std::remove(get_tmp_path("tool-variant:take2.wav").c_str());
+    ASSERT_EQ(run_tool({tool, in, get_tmp_path("tool-variant:take2.wav")}).status, 0);
+    sf::file::info info;
+    EXPECT_EQ(read_all(get_tmp_path("tool-variant:take2.wav"), info), speed_cycle_reference(signal, channels, 1.0, 3.0));
+
+    ASSERT_EQ(run_tool({tool, in, get_tmp_path("tool-variant.wav") + ":2,2"}).status, 0);
+    EXPECT_EQ(read_all(get_tmp_path("tool-variant.wav"), info), speed_cycle_reference(signal, channels, 2.0, 2.0));
+
+    // Speeds must satisfy 0 < minspeed <= maxspeed.
+    for (const char* speeds : {":0,1", ":-1,2", ":3,1", ":nan,nan"})
+    {
+        EXPECT_NE(run_tool({tool, in, get_tmp_path("tool-variant.wav") + speeds}).status, 0) << speeds;
+    }
+}
+
+TEST(ToolTest, QcTest)
+{
+    if (access(get_tool_path("speed-cycle").c_str(), X_OK) != 0 ||
+        access(get_tool_path("accel-decel").c_str(), X_OK) != 0)
+    {
+        GTEST_SKIP() << "speed-cycle and accel-decel have not been built";
+    }
+
+    constexpr int channels = 2;
+    auto signal = synth::tone(10 * samplerate, samplerate, channels, 997.0, 0.5);
+    synth::write(get_tmp_path("tool-qc-in.wav"), signal, samplerate, channels);
+
+    std::remove(get_tmp_path("tool-qc-speed.wav.qc").c_str());
+    std::remove(get_tmp_path("tool-qc-accel.wav.qc").c_str());
+    ASSERT_EQ(run_tool({get_tool_path("speed-cycle"), "--qc", get_tmp_path("tool-qc-in.wav"),
+                        get_tmp_path("tool-qc-speed.wav")}).status, 0);
+    ASSERT_EQ(run_tool({get_tool_path("accel-decel"), "--qc", get_tmp_path("tool-qc-in.wav"),
+                        get_tmp_path("tool-qc-accel.wav"), "0.000001", "2,5"}).status, 0);
+
+    for (const char* name : {"tool-qc-speed.wav.qc", "tool-qc-accel.wav.qc"})
+    {
+        std::map<std::string, std::string> results;
+        std::ifstream qc(get_tmp_path(name));
+        std::string line;
+        while (std::getline(qc, line))
+        {
+            auto equals = line.find('=');
+            ASSERT_NE(equals, std::string::npos) << line;
+            results[line.substr(0, equals)] = line.substr(equals + 1);
+        }
+        ASSERT_EQ(results.size(), 4u) << name;
+        EXPECT_NEAR(std::stod(results["peak_dbfs"]), -6.02, 0.01) << name;
+        EXPECT_EQ(results["clips"], "0") << name;
+    }
+}
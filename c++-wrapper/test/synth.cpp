@@ -0,0 +1,123 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+#include "synth.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace synth
+{
+    std::vector<float>
+    tone(sf::count_t frames, int samplerate, int channels, double frequency, double amplitude)
+    {
+        std::vector<float> result(frames * channels);
+        for (int chan = 0; chan < channels; ++chan)
+        {
+            double step = 2.0 * M_PI * frequency * (chan + 1) / samplerate;
+            for (sf::count_t i = 0; i < frames; ++i)
+            {
+                result[i * channels + chan] = amplitude * std::sin(step * i);
+            }
+        }
+        return result;
+    }
+
+    std::vector<float>
+    noise(sf::count_t frames, int channels, std::uint32_t seed, double amplitude)
+    {
+        // xorshift32, so that the sequence doesn't depend on the standard
+        // library's distributions.
+        std::uint32_t state = seed != 0 ? seed : 1;
+        std::vector<float> result(frames * channels);
+        for (auto& sample : result)
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            sample = amplitude * (state / 2147483648.0 - 1.0);
+        }
+        return result;
+    }
+
+    std::vector<float>
+    chirp(sf::count_t frames, int samplerate, int channels, double f0, double f1, double amplitude)
+    {
+        std::vector<float> result(frames * channels);
+        double duration = static_cast<double>(frames) / samplerate;
+        double rate = duration > 0.0 ? (f1 - f0) / duration : 0.0;
+        for (sf::count_t i = 0; i < frames; ++i)
+        {
+            double t = static_cast<double>(i) / samplerate;
+            double phase = 2.0 * M_PI * (f0 * t + rate * t * t / 2.0);
+            for (int chan = 0; chan < channels; ++chan)
+            {
+                result[i * channels + chan] = amplitude * std::sin(phase + chan * M_PI / channels);
+            }
+        }
+        return result;
+    }
+
+    namespace
+    {
+        constexpr sf::count_t ramp_period = 1 << 24;
+    }
+
+    std::vector<float>
+    ramp(sf::count_t frames, int channels)
+    {
+        std::vector<float> result(frames * channels);
+        for (sf::count_t i = 0; i < frames; ++i)
+        {
+            float value = static_cast<float>(i % ramp_period) / ramp_period;
+            std::fill_n(result.begin() + i * channels, channels, value);
+        }
+        return result;
+    }
+
+    sf::count_t
+    ramp_step(float from, float to)
+    {
+        auto step = static_cast<sf::count_t>(std::lround((to - static_cast<double>(from)) * ramp_period));
+        return (step % ramp_period + ramp_period) % ramp_period;
+    }
+
+    void
+    write(const std::string& path, const std::vector<float>& samples, int samplerate, int channels, int format)
+    {
+        sf::file::info info{};
+        info.samplerate = samplerate;
+        info.channels = channels;
+        info.format = format;
+        sf::file out(path, SFM_WRITE, info);
+
+        const size_t block = (1024 * 1024 / channels) * channels;
+        for (size_t begin = 0; begin < samples.size();)
+        {
+            size_t end = std::min(begin + block, samples.size());
+            out.write(std::vector<float>(samples.begin() + begin, samples.begin() + end));
+            begin = end;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+//
+//  MIT License
+//  
+//  Copyright (c) 2021 Hans Erickson
+//  
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to deal
+//  in the Software without restriction, including without limitation the rights
+//  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//  copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//  
+//  The above copyright notice and this permission notice shall be included in all
+//  copies or substantial portions of the Software.
+//  
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//  SOFTWARE.
+//  
+
+#ifndef SF_TEST_SYNTH_H
+#define SF_TEST_SYNTH_H
+
+#include "../sf.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Deterministic synthetic signals for tests. Every generator returns
+// interleaved samples and gives each channel a different signal, so
+// that channel mix-ups show up in comparisons.
+namespace synth
+{
+    // Sine of <frequency> Hz on channel 0, <frequency> * (c + 1) on channel c.
+    std::vector<float>
+    tone(sf::count_t frames, int samplerate, int channels, double frequency, double amplitude = 0.5);
+
+    // Uniform white noise. The same seed always gives the same samples.
+    std::vector<float>
+    noise(sf::count_t frames, int channels, std::uint32_t seed, double amplitude = 0.5);
+
+    // Linear sweep from <f0> to <f1> Hz over the whole signal, with
+    // channel c starting c * pi / channels radians later.
+    std::vector<float>
+    chirp(sf::count_t frames, int samplerate, int channels, double f0, double f1, double amplitude = 0.5);
+
+    // Every channel of frame i holds (i mod 2^24) / 2^24, which is exact in
+    // a float, so the source frame of any output sample can be recovered.
+    std::vector<float>
+    ramp(sf::count_t frames, int channels);
+
+    // Source frame offset between two samples of a ramp
+    sf::count_t
+    ramp_step(float from, float to);
+
+    // Write <samples> to a file, by default a float WAV, which reads back
+    // exactly.
+    void
+    write(const std::string& path, const std::vector<float>& samples, int samplerate, int channels,
+          int format = SF_FORMAT_WAV | SF_FORMAT_FLOAT);
+}
+
+#endif
@@ -24,8 +24,19 @@
 
 #include <gtest/gtest.h>
 
+#include "../fanout.h"
 #include "../sf.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace
 {
     std::string
@@ -39,6 +50,41 @@ namespace
     {
         return std::string("/tmp/") + fname;
     }
+
+    // Parse the output of analysis::to_string(), failing on any value that
+    // isn't just a number.
+    std::map<std::string, double>
+    parse_results(const std::string& text)
+    {
+        std::map<std::string, double> result;
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            auto equals = line.find('=');
+            EXPECT_NE(equals, std::string::npos) << line;
+            if (equals == std::string::npos)
+            {
+                continue;
+            }
+            std::string value = line.substr(equals + 1);
+            size_t used = 0;
+            result[line.substr(0, equals)] = std::stod(value, &used);
+            EXPECT_EQ(used, value.size()) << line;
+        }
+        return result;
+    }
+
+    std::vector<float>
+    sine(int samplerate, int frames, double amplitude)
+    {
+        std::vector<float> result(frames);
+        for (size_t i = 0; i < result.size(); ++i)
+        {
+            result[i] = amplitude * std::sin(2.0 * M_PI * 997.0 * i / samplerate);
+        }
+        return result;
+    }
 }
 
 TEST(WrapperTest, BellTest)
@@ -67,3 +113,183 @@ TEST(WrapperTest, BellTest)
     sf::file out(get_tmp_path("reverse-bell.ogg"), SFM_WRITE, winfo);
     out.write(reverse);
 }
+
+TEST(WrapperTest, AnalysisTest)
+{
+    // A full-scale 997 Hz sine in one channel reads -3.01 LUFS (ITU-R BS.1770)
+    constexpr int samplerate = 48000;
+    std::vector<float> sine(samplerate * 5);
+    for (size_t i = 0; i < sine.size(); ++i)
+    {
+        sine[i] = std::sin(2.0 * M_PI * 997.0 * i / samplerate);
+    }
+
+    sf::analysis analysis(samplerate, 1);
+    analysis.add(sine.data(), 1000);
+    analysis.add(sine.data() + 1000, sine.size() - 1000);
+    EXPECT_NEAR(analysis.peak(), 0.0, 0.01);
+    EXPECT_NEAR(analysis.rms(), -3.01, 0.01);
+    EXPECT_NEAR(analysis.loudness(), -3.01, 0.05);
+
+    sf::analysis silence(samplerate, 2);
+    std::vector<short> zeros(samplerate * 2);
+    silence.add(zeros.data(), zeros.size());
+    EXPECT_EQ(silence.clips(), 0);
+    EXPECT_TRUE(std::isinf(silence.loudness()));
+
+    sf::analysis clipped(samplerate, 2);
+    std::vector<short> full(samplerate * 2, 32767);
+    clipped.add(full.data(), full.size());
+    EXPECT_EQ(clipped.clips(), static_cast<sf::count_t>(full.size()));
+}
+
+TEST(WrapperTest, WriteAnalysisTest)
+{
+    constexpr int samplerate = 48000;
+    sf::file::info winfo{};
+    winfo.samplerate = samplerate;
+    winfo.channels = 1;
+    winfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    sf::file out(get_tmp_path("analysis.wav"), SFM_WRITE, winfo);
+    EXPECT_THROW(out.get_analysis(), std::runtime_error);
+
+    // Only what is written after analyze() counts.
+    out.write(sine(samplerate, samplerate, 1.0));
+    out.analyze();
+    auto half = sine(samplerate, samplerate, 0.5);
+    out.write(std::vector<float>(half.begin(), half.begin() + 1000));
+    out.write(std::vector<double>(half.begin() + 1000, half.end()));
+
+    const sf::analysis& analysis = out.get_analysis();
+    EXPECT_NEAR(analysis.peak(), -6.02, 0.01);
+    EXPECT_NEAR(analysis.rms(), -9.03, 0.01);
+    EXPECT_EQ(analysis.clips(), 0);
+
+    auto results = parse_results(analysis.to_string());
+    EXPECT_EQ(results.size(), 4u);
+    EXPECT_NEAR(results["peak_dbfs"], analysis.peak(), 1e-4);
+    EXPECT_NEAR(results["rms_dbfs"], analysis.rms(), 1e-4);
+    EXPECT_NEAR(results["loudness_lufs"], analysis.loudness(), 1e-4);
+    EXPECT_EQ(results["clips"], 0.0);
+}
+
+TEST(WrapperTest, OutputTest)
+{
+    constexpr int samplerate = 48000;
+    sf::file::info winfo{};
+    winfo.samplerate = samplerate;
+    winfo.channels = 2;
+    winfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+
+    // Channels set out of order, a frame left half unset, and QC results
+    // written alongside.
+    std::remove(get_tmp_path("output.wav.qc").c_str());
+    {
+        sf::output out(get_tmp_path("output.wav"), winfo, true);
+        out.set(0, 1, 0.25);
+        out.set(0, 0, 0.5);
+        out.flush(1);
+        EXPECT_EQ(out.frames(), 1);
+        out.set(2, 0, -0.5);
+        out.finish();
+        EXPECT_EQ(out.frames(), 3);
+    }
+
+    sf::file::info rinfo;
+    sf::file in(get_tmp_path("output.wav"), SFM_READ, rinfo);
+    EXPECT_EQ(rinfo.frames, 3);
+    std::vector<float> buffer(rinfo.frames * rinfo.channels);
+    in.read(buffer);
+    EXPECT_EQ(buffer, (std::vector<float>{0.5f, 0.25f, 0.0f, 0.0f, -0.5f, 0.0f}));
+
+    std::ifstream qc(get_tmp_path("output.wav.qc"));
+    std::stringstream text;
+    text << qc.rdbuf();
+    auto results = parse_results(text.str());
+    EXPECT_NEAR(results["peak_dbfs"], -6.02, 0.01);
+    EXPECT_EQ(results["clips"], 0.0);
+
+    // No sidecar without QC
+    std::remove(get_tmp_path("output-noqc.wav.qc").c_str());
+    {
+        sf::output out(get_tmp_path("output-noqc.wav"), winfo, false);
+        out.set(0, 0, 0.5);
+        out.finish();
+    }
+    EXPECT_FALSE(std::ifstream(get_tmp_path("output-noqc.wav.qc")).good());
+}
+
+namespace
+{
+    // Copies every <step>th input frame, keeping track of how many frames
+    // the window held.
+    class step_renderer final : public sf::renderer
+    {
+    public:
+        explicit step_renderer(sf::count_t step)
+            : step_(step)
+        {
+        }
+
+        bool
+        render(const sf::window& input) override
+        {
+            held = std::max(held, input.end() - input.begin());
+            for (; frame_ < input.end(); frame_ += step_)
+            {
+                copied.push_back(input.get(frame_, 1));
+            }
+            return input.end() != input.frames();
+        }
+
+        sf::count_t
+        position() const override
+        {
+            return frame_;
+        }
+
+        std::vector<double> copied;
+        sf::count_t held = 0;
+
+    private:
+        sf::count_t step_;
+        sf::count_t frame_ = 0;
+    };
+}
+
+TEST(WrapperTest, FanOutTest)
+{
+    constexpr int samplerate = 48000;
+    constexpr int frames = 10 * samplerate;
+    sf::file::info winfo{};
+    winfo.samplerate = samplerate;
+    winfo.channels = 2;
+    winfo.format = SF_FORMAT_WAV | SF_FORMAT_FLOAT;
+    {
+        std::vector<float> ramp(frames * 2);
+        for (size_t i = 0; i < ramp.size(); ++i)
+        {
+            ramp[i] = static_cast<float>(i / 2) / frames;
+        }
+        sf::file out(get_tmp_path("fanout.wav"), SFM_WRITE, winfo);
+        out.write(ramp);
+    }
+
+    sf::file::info rinfo;
+    sf::file in(get_tmp_path("fanout.wav"), SFM_READ, rinfo);
+    step_renderer slow(1);
+    step_renderer fast(3);
+    EXPECT_EQ(sf::fan_out(in, rinfo, {&slow, &fast}), frames);
+
+    ASSERT_EQ(slow.copied.size(), static_cast<size_t>(frames));
+    ASSERT_EQ(fast.copied.size(), static_cast<size_t>((frames + 2) / 3));
+    for (size_t i = 0; i < fast.copied.size(); ++i)
+    {
+        ASSERT_EQ(fast.copied[i], static_cast<float>(i * 3) / frames) << i;
+    }
+    EXPECT_EQ(slow.copied.back(), static_cast<float>(frames - 1) / frames);
+
+    // The renderers stay in lockstep, so only a block or so is held at once.
+    EXPECT_LT(slow.held, samplerate);
+    EXPECT_LT(fast.held, samplerate);
+}
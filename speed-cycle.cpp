@@ -22,77 +22,183 @@
 //  SOFTWARE.
 //  
 
-#include "c++-wrapper/sf.h"
+#include "c++-wrapper/fanout.h"
 
 #include <algorithm>
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
 #include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace
 {
+    // One rendering of the input. Any number of these may be rendered
+    // from a single decode of the input file.
+    struct variant
+    {
+        std::string path;
+        double minspeed = 1.0;
+        double maxspeed = 3.0;
+    };
+
     void
     usage(const char* name)
     {
-        std::cerr << "Usage: " << name << " <infile> <outfile>" << std::endl;
+        std::cerr << "Usage: " << name << " [--qc] <infile> <outfile>[:<minspeed>,<maxspeed>] [<outfile>[:<minspeed>,<maxspeed>]...]" << std::endl;
         exit(EXIT_FAILURE);
     }
-}
 
-int main(int argc, char** argv)
-{
-    if (argc != 3)
+    variant
+    get_variant(const std::string& arg, const char* name)
     {
-        usage(argv[0]);
-    }
+        variant v;
+        v.path = arg;
 
-    sf::file::info info;
-    sf::file in(argv[1], SFM_READ, info);
-    sf::file out(argv[2], SFM_WRITE, info);
+        // Whatever follows the last ':' gives the speeds only if it parses as
+        // two numbers, so that a path such as out:take2.wav still works.
+        auto colon = arg.rfind(':');
+        double minspeed;
+        double maxspeed;
+        int used = 0;
+        if (colon != std::string::npos &&
+            sscanf(arg.c_str() + colon + 1, "%lf,%lf%n", &minspeed, &maxspeed, &used) == 2 &&
+            colon + 1 + used == arg.size())
+        {
+            // A speed of zero or less would never reach the end of the input.
+            if (!(0.0 < minspeed && minspeed <= maxspeed))
+            {
+                std::cerr << arg << ": speeds must satisfy 0 < minspeed <= maxspeed" << std::endl;
+                usage(name);
+            }
+            v.path = arg.substr(0, colon);
+            v.minspeed = minspeed;
+            v.maxspeed = maxspeed;
+        }
+        return v;
+    }
 
-    std::vector<double> input(info.frames * info.channels);
-    if (input.size() == 0)
+    // Each channel is resampled by itself, at a speed that swings between
+    // minspeed and maxspeed, with odd channels in antiphase. Every channel
+    // moves through the input at its own speed, so each keeps its own
+    // position, and output frames are only complete once every channel
+    // still running has reached them.
+    class renderer final : public sf::renderer
     {
-        input.resize(100 * 1000 * 1000);
-    }
+    public:
+        renderer(const variant& v, const sf::file::info& info, bool qc)
+            : v_(v),
+              samplerate_(info.samplerate),
+              out_(v.path, info, qc),
+              offsets_(info.channels, 0.0),
+              counts_(info.channels, 0)
+        {
+        }
 
-    std::vector<double> output;
-    output.reserve(input.size());
+        const sf::output&
+        out() const
+        {
+            return out_;
+        }
 
-    in.read(input);
+        bool
+        render(const sf::window& input) override
+        {
+            bool running = false;
+            sf::count_t complete = 0;
+            for (size_t chan = 0; chan < offsets_.size(); ++chan)
+            {
+                double& offset = offsets_[chan];
+                sf::count_t& count = counts_[chan];
+                double phase = chan * M_PI;
+                while (offset >= 0.0 && offset < input.end())
+                {
+                    out_.set(count, chan, input.get(static_cast<sf::count_t>(offset), chan));
+                    // Speed swings between minspeed and maxspeed
+                    offset += (v_.maxspeed - v_.minspeed) / 2.0 * sin(static_cast<double>(count) * M_PI / (samplerate_ * 10) + phase) + (v_.maxspeed + v_.minspeed) / 2.0;
 
-    std::cout << "input.size() is " << input.size() << std::endl;
+                    ++count;
+                }
 
-    for (int chan = 0; chan < info.channels; ++chan)
-    {
-        std::cerr << "Doing channel " << chan << std::endl;
-        int count = 0;
-        double offset = 0;
-        double phase = chan * M_PI;
-        double minspeed = 1.0;
-        double maxspeed = 3.0;
-        while (offset >= 0.0 && offset < input.size() / info.channels)
-        {
-            int in_index = static_cast<int>(offset) * info.channels + chan;
-            int out_index = count * info.channels + chan;
+                if (offset >= 0.0 && (input.frames() < 0 || offset < input.frames()))
+                {
+                    complete = running ? std::min(complete, count) : count;
+                    running = true;
+                }
+            }
 
-            if (output.size() <= out_index)
+            if (!running)
             {
-                output.resize(out_index + 1);
+                out_.finish();
+                return false;
             }
-            output[out_index] = input[in_index];
-            offset += sin(static_cast<double>(count) * M_PI / (info.samplerate * 10) + phase) + (maxspeed - minspeed) / 2.0 + 1.0;
+            out_.flush(complete);
+            return true;
+        }
 
-            ++count;
+        sf::count_t
+        position() const override
+        {
+            return static_cast<sf::count_t>(*std::min_element(offsets_.begin(), offsets_.end()));
         }
-    }
 
-    for (size_t begin = 0; begin < output.size();)
+    private:
+        variant v_;
+        int samplerate_;
+        sf::output out_;
+        std::vector<double> offsets_;
+        std::vector<sf::count_t> counts_;
+    };
+}
+
+int main(int argc, char** argv)
+    try
     {
-        size_t end = std::min(begin + 1024 * 1024, output.size());
-        std::vector buffer(output.begin() + begin, output.begin() + end);
-        out.write(buffer);
-        begin = end;
+        const char* name = argv[0];
+        bool qc = argc > 1 && std::strcmp(argv[1], "--qc") == 0;
+        if (qc)
+        {
+            ++argv;
+            --argc;
+        }
+
+        if (argc < 3)
+        {
+            usage(name);
+        }
+
+        std::vector<variant> variants;
+        for (int i = 2; i < argc; ++i)
+        {
+            variants.push_back(get_variant(argv[i], name));
+        }
+
+        sf::file::info info;
+        sf::file in(argv[1], SFM_READ, info);
+
+        // Open every output up front so that a bad path fails before decoding.
+        std::vector<std::unique_ptr<renderer>> renderers;
+        std::vector<sf::renderer*> fan;
+        for (const auto& v : variants)
+        {
+            renderers.push_back(std::make_unique<renderer>(v, info, qc));
+            fan.push_back(renderers.back().get());
+        }
+
+        sf::count_t frames = sf::fan_out(in, info, fan);
+
+        std::cout << "input.size() is " << frames * info.channels << std::endl;
+        for (const auto& r : renderers)
+        {
+            std::cerr << "output size of " << r->out().path() << " is " << r->out().frames() * info.channels << std::endl;
+        }
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        exit(EXIT_FAILURE);
     }
-    std::cerr << "output size is " << output.size() << std::endl;
-}